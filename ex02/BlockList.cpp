@@ -0,0 +1,101 @@
+#include "BlockList.hpp"
+#include <algorithm>
+#include <cmath>
+
+BlockList::BlockList() : _size(0) {}
+
+BlockList::BlockList(const BlockList& other) : _blocks(other._blocks), _starts(other._starts), _size(other._size) {}
+
+BlockList& BlockList::operator=(const BlockList& other) {
+    if (this != &other) {
+        _blocks = other._blocks;
+        _starts = other._starts;
+        _size = other._size;
+    }
+    return *this;
+}
+
+BlockList::~BlockList() {}
+
+size_t BlockList::blockLimit() const {
+    size_t limit = static_cast<size_t>(std::sqrt(static_cast<double>(_size)));
+    return std::max(limit, static_cast<size_t>(64));
+}
+
+size_t BlockList::blockOf(size_t rank) const {
+    return std::upper_bound(_starts.begin(), _starts.end(), rank) - _starts.begin() - 1;
+}
+
+/* moves the upper half of block b into a new block right after it,
+   swapping the following blocks down instead of copying them */
+void BlockList::splitBlock(size_t b) {
+    _blocks.push_back(std::vector<int>());
+    _starts.push_back(0);
+    for (size_t i = _blocks.size() - 1; i > b + 1; --i) {
+        _blocks[i].swap(_blocks[i - 1]);
+        _starts[i] = _starts[i - 1];
+    }
+
+    std::vector<int>& block = _blocks[b];
+    size_t half = block.size() / 2;
+    _blocks[b + 1].assign(block.begin() + half, block.end());
+    block.resize(half);
+    _starts[b + 1] = _starts[b] + half;
+}
+
+size_t BlockList::size() const {
+    return _size;
+}
+
+void BlockList::push_back(int value) {
+    if (_blocks.empty() || _blocks.back().size() >= blockLimit()) {
+        _blocks.push_back(std::vector<int>());
+        _starts.push_back(_size);
+    }
+    _blocks.back().push_back(value);
+    ++_size;
+}
+
+void BlockList::insert(size_t rank, int value) {
+    if (rank >= _size) {
+        push_back(value);
+        return;
+    }
+
+    size_t b = blockOf(rank);
+    std::vector<int>& block = _blocks[b];
+    block.insert(block.begin() + (rank - _starts[b]), value);
+    for (size_t i = b + 1; i < _starts.size(); ++i)
+        ++_starts[i];
+    ++_size;
+
+    if (block.size() > 2 * blockLimit())
+        splitBlock(b);
+}
+
+int BlockList::operator[](size_t rank) const {
+    size_t b = blockOf(rank);
+    return _blocks[b][rank - _starts[b]];
+}
+
+/* rank of the first element not less than value, assuming the list is sorted */
+size_t BlockList::rankOf(int value) const {
+    size_t lo = 0;
+    size_t hi = _blocks.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_blocks[mid].back() < value) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == _blocks.size()) return _size;
+
+    const std::vector<int>& block = _blocks[lo];
+    return _starts[lo] + (std::lower_bound(block.begin(), block.end(), value) - block.begin());
+}
+
+void BlockList::toVector(std::vector<int>& out) const {
+    out.clear();
+    out.reserve(_size);
+    for (size_t b = 0; b < _blocks.size(); ++b)
+        out.insert(out.end(), _blocks[b].begin(), _blocks[b].end());
+}
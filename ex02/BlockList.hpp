@@ -0,0 +1,35 @@
+#ifndef BLOCKLIST_HPP
+#define BLOCKLIST_HPP
+
+#include <vector>
+#include <cstddef>
+
+/* sorted sequence stored as a list of small blocks, so inserting in the
+   middle only shifts one block and the block start ranks after it;
+   blocks are kept around sqrt(size) elements, which makes both costs
+   O(sqrt n) instead of the O(n) shift of a vector or deque */
+class BlockList {
+private:
+    std::vector<std::vector<int> > _blocks;
+    std::vector<size_t> _starts;
+    size_t _size;
+
+    size_t blockLimit() const;
+    size_t blockOf(size_t rank) const;
+    void splitBlock(size_t b);
+
+public:
+    BlockList();
+    BlockList(const BlockList& other);
+    BlockList& operator=(const BlockList& other);
+    ~BlockList();
+
+    size_t size() const;
+    void push_back(int value);
+    void insert(size_t rank, int value);
+    int operator[](size_t rank) const;
+    size_t rankOf(int value) const;
+    void toVector(std::vector<int>& out) const;
+};
+
+#endif
@@ -1,14 +1,29 @@
 #include "PmergeMe.hpp"
 #include <iostream>
 
-PmergeMe::PmergeMe() {}
+PmergeMe::PmergeMe() : _inputMode(INPUT_ARGS), _threadCount(0), _hybridThreshold(0), _networkThreshold(0), _benchRepeats(0), _benchSize(3000), _streamBatch(0), _containers(0), _counting(true), _comparisons(0) {}
 
-PmergeMe::PmergeMe(const PmergeMe& other) : _vectorContainer(other._vectorContainer), _dequeContainer(other._dequeContainer) {}
+PmergeMe::PmergeMe(const PmergeMe& other) : _vectorContainer(other._vectorContainer), _dequeContainer(other._dequeContainer),
+    _inputMode(other._inputMode), _inputPath(other._inputPath),
+    _threadCount(other._threadCount), _hybridThreshold(other._hybridThreshold), _networkThreshold(other._networkThreshold),
+    _benchRepeats(other._benchRepeats), _benchSize(other._benchSize), _streamBatch(other._streamBatch), _containers(other._containers),
+    _counting(other._counting), _comparisons(other._comparisons) {}
 
 PmergeMe& PmergeMe::operator=(const PmergeMe& other) {
     if (this != &other) {
         _vectorContainer = other._vectorContainer;
         _dequeContainer = other._dequeContainer;
+        _inputMode = other._inputMode;
+        _inputPath = other._inputPath;
+        _threadCount = other._threadCount;
+        _hybridThreshold = other._hybridThreshold;
+        _networkThreshold = other._networkThreshold;
+        _benchRepeats = other._benchRepeats;
+        _benchSize = other._benchSize;
+        _streamBatch = other._streamBatch;
+        _containers = other._containers;
+        _counting = other._counting;
+        _comparisons = other._comparisons;
     }
     return *this;
 }
@@ -16,53 +31,148 @@ PmergeMe& PmergeMe::operator=(const PmergeMe& other) {
 PmergeMe::~PmergeMe() {}
 
 double PmergeMe::getTime() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
 }
 
-bool PmergeMe::parseInput(int argc, char **argv) {
-    if (argc < 2) { 
-        std::cerr << "Error" << std::endl; 
-        return false; 
+bool PmergeMe::parseCount(const std::string& str, size_t& out) {
+    if (str.empty() || str.length() > 9) return false;
+    for (size_t i = 0; i < str.length(); ++i) {
+        if (!std::isdigit(str[i])) return false;
     }
+    std::stringstream ss(str);
+    ss >> out;
+    return !ss.fail() && out > 0;
+}
 
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        
-        if (arg.empty() || arg[0] == '-') { 
-            std::cerr << "Error" << std::endl; 
-            return false; 
-        }
+/* comma separated list of vector, deque and blocklist */
+bool PmergeMe::parseContainers(const std::string& list) {
+    std::stringstream ss(list);
+    std::string name;
+    _containers = 0;
+    while (std::getline(ss, name, ',')) {
+        if (name == "vector") _containers |= CONTAINER_VECTOR;
+        else if (name == "deque") _containers |= CONTAINER_DEQUE;
+        else if (name == "blocklist") _containers |= CONTAINER_BLOCKLIST;
+        else return false;
+    }
+    return _containers != 0 && list[list.length() - 1] != ',';
+}
 
-        for (size_t j = 0; j < arg.length(); ++j) {
-            if (!std::isdigit(arg[j])) { 
-                std::cerr << "Error" << std::endl; 
-                return false; 
+/* argv inputs time every container like before; bulk inputs can be far
+   too large for the quadratic vector and deque paths, so they only time
+   BlockList unless --containers asks for more. --hybrid and --threads
+   compare against std::vector, so they always add it */
+unsigned int PmergeMe::selectedContainers() const {
+    unsigned int containers = _containers;
+    if (containers == 0)
+        containers = (_inputMode == INPUT_ARGS) ? CONTAINER_ALL : CONTAINER_BLOCKLIST;
+    if (_hybridThreshold > 0 || _threadCount > 0)
+        containers |= CONTAINER_VECTOR;
+    return containers;
+}
+
+/* options come before the numbers and always start with "--",
+   so they can never be mistaken for a (rejected) negative number */
+bool PmergeMe::parseOptions(int argc, char **argv, int& first) {
+    first = 1;
+    while (first < argc) {
+        std::string arg = argv[first];
+        if (arg.compare(0, 2, "--") != 0) break;
+
+        if (arg.compare(0, 10, "--threads=") == 0) {
+            if (!parseCount(arg.substr(10), _threadCount)) {
+                std::cerr << "Error" << std::endl;
+                return false;
+            }
+        } else if (arg.compare(0, 7, "--file=") == 0 && arg.length() > 7) {
+            _inputMode = INPUT_FILE;
+            _inputPath = arg.substr(7);
+        } else if (arg.compare(0, 9, "--binary=") == 0 && arg.length() > 9) {
+            _inputMode = INPUT_BINARY;
+            _inputPath = arg.substr(9);
+        } else if (arg.compare(0, 9, "--hybrid=") == 0) {
+            /* fordJohnsonSort returns before the network below two elements,
+               so a threshold of 0 or 1 would never use it */
+            if (!parseCount(arg.substr(9), _hybridThreshold) || _hybridThreshold < 2 || _hybridThreshold > SORTING_NETWORK_MAX) {
+                std::cerr << "Error" << std::endl;
+                return false;
+            }
+        } else if (arg.compare(0, 8, "--bench=") == 0) {
+            if (!parseCount(arg.substr(8), _benchRepeats)) {
+                std::cerr << "Error" << std::endl;
+                return false;
+            }
+        } else if (arg.compare(0, 7, "--size=") == 0) {
+            if (!parseCount(arg.substr(7), _benchSize)) {
+                std::cerr << "Error" << std::endl;
+                return false;
             }
+        } else if (arg.compare(0, 9, "--stream=") == 0) {
+            if (!parseCount(arg.substr(9), _streamBatch)) {
+                std::cerr << "Error" << std::endl;
+                return false;
+            }
+        } else if (arg.compare(0, 13, "--containers=") == 0) {
+            if (!parseContainers(arg.substr(13))) {
+                std::cerr << "Error" << std::endl;
+                return false;
+            }
+        } else if (arg == "--stdin") {
+            _inputMode = INPUT_STDIN;
+        } else {
+            std::cerr << "Error" << std::endl;
+            return false;
         }
+        ++first;
+    }
+    return true;
+}
+
+bool PmergeMe::parseInput(int argc, char **argv, int first) {
+    if (_inputMode != INPUT_ARGS) {
+        bool ok = false;
+        if (argc == first) {
+            if (_inputMode == INPUT_FILE) ok = readTextFile(_inputPath);
+            else if (_inputMode == INPUT_STDIN) ok = readStdin();
+            else ok = readBinaryFile(_inputPath);
+        }
+        if (!ok) std::cerr << "Error" << std::endl;
+        return ok;
+    }
+
+    if (argc <= first) { 
+        std::cerr << "Error" << std::endl; 
+        return false; 
+    }
 
-        std::stringstream ss(arg);
+    for (int i = first; i < argc; ++i) {
+        const char* p = argv[i];
+        const char* end = p + std::strlen(p);
         int num;
-        ss >> num;
-        if (ss.fail() || !ss.eof() || num < 0) { 
+        if (!parseNumber(p, end, num) || p != end) { 
             std::cerr << "Error" << std::endl; 
             return false; 
         }
         
         _vectorContainer.push_back(num);
-        _dequeContainer.push_back(num);
     }
     
     return true;
 }
 
+/* bulk inputs can hold millions of numbers, only their head is shown */
 void PmergeMe::printSequence(const std::vector<int>& seq, const std::string& prefix) {
+    size_t limit = seq.size();
+    if (_inputMode != INPUT_ARGS && limit > 20) limit = 20;
+
     std::cout << prefix << std::endl;
-    for (size_t i = 0; i < seq.size() ; ++i) {
+    for (size_t i = 0; i < limit ; ++i) {
         if (i > 0) std::cout << " ";
         std::cout << seq[i];
     }
+    if (limit < seq.size()) std::cout << " [...]";
     std::cout << std::endl;
 }
 
@@ -89,18 +199,47 @@ std::vector<size_t> PmergeMe::generateJacobsthalNumbers(size_t n) {
 
 void PmergeMe::binaryInsert(std::vector<int>& arr, int value, size_t end) {
     size_t searchEnd = std::min(end, arr.size());
-    std::vector<int>::iterator pos = std::lower_bound(arr.begin(), arr.begin() + searchEnd, value);
+    std::vector<int>::iterator pos;
+    if (_counting) pos = std::lower_bound(arr.begin(), arr.begin() + searchEnd, value, CountingLess(&_comparisons));
+    else pos = std::lower_bound(arr.begin(), arr.begin() + searchEnd, value);
     arr.insert(pos, value);
 }
 
 void PmergeMe::binaryInsert(std::deque<int>& arr, int value, size_t end) {
     size_t searchEnd = std::min(end, arr.size());
-    std::deque<int>::iterator pos = std::lower_bound(arr.begin(), arr.begin() + searchEnd, value);
+    std::deque<int>::iterator pos;
+    if (_counting) pos = std::lower_bound(arr.begin(), arr.begin() + searchEnd, value, CountingLess(&_comparisons));
+    else pos = std::lower_bound(arr.begin(), arr.begin() + searchEnd, value);
     arr.insert(pos, value);
 }
 
+/* same halving as std::lower_bound, so the comparison count is unchanged */
+void PmergeMe::binaryInsert(BlockList& arr, int value, size_t end) {
+    size_t first = 0;
+    size_t len = std::min(end, arr.size());
+    size_t steps = 0;
+    while (len > 0) {
+        size_t half = len / 2;
+        ++steps;
+        if (arr[first + half] < value) {
+            first += half + 1;
+            len -= half + 1;
+        } else {
+            len = half;
+        }
+    }
+    if (_counting) _comparisons += steps;
+    arr.insert(first, value);
+}
+
 void PmergeMe::fordJohnsonSort(std::vector<int>& arr) {
     if (arr.size() <= 1) return;
+
+    /* hybrid mode: small subproblems go through the sorting network */
+    if (arr.size() <= _networkThreshold) {
+        _comparisons += sortingNetwork(&arr[0], arr.size());
+        return;
+    }
     
     std::vector<std::pair<int, int> > pairs;
     bool hasStraggler = false;
@@ -114,6 +253,9 @@ void PmergeMe::fordJohnsonSort(std::vector<int>& arr) {
         }
     }
     
+    /* one comparison per pair */
+    _comparisons += arr.size() / 2;
+
     if (arr.size() % 2 == 1) {
         hasStraggler = true;
         straggler = arr[arr.size() - 1];
@@ -158,14 +300,10 @@ void PmergeMe::fordJohnsonSort(std::vector<int>& arr) {
                 for (size_t j = end; j >= start && j >= 1; --j) {
                     size_t idx = j - 1;
                     if (idx < pendingElements.size() && !inserted[idx]) {
-                        /* find position of the corresponding larger element */
-                        size_t limit = mainChain.size();
-                        for (size_t k = 0; k < mainChain.size(); ++k) {
-                            if (mainChain[k] == pairs[idx].second) {
-                                limit = k + 1;
-                                break;
-                            }
-                        }
+                        /* the main chain stays sorted, so the corresponding larger
+                           element is found by an uncounted binary search */
+                        size_t limit = std::lower_bound(mainChain.begin(), mainChain.end(), pairs[idx].second)
+                            - mainChain.begin() + 1;
                         binaryInsert(mainChain, pendingElements[idx], limit);
                         inserted[idx] = true;
                     }
@@ -174,13 +312,8 @@ void PmergeMe::fordJohnsonSort(std::vector<int>& arr) {
             
             for (size_t i = 1; i < pendingElements.size(); ++i) {
                 if (!inserted[i]) {
-                    size_t limit = mainChain.size();
-                    for (size_t k = 0; k < mainChain.size(); ++k) {
-                        if (mainChain[k] == pairs[i].second) {
-                            limit = k + 1;
-                            break;
-                        }
-                    }
+                    size_t limit = std::lower_bound(mainChain.begin(), mainChain.end(), pairs[i].second)
+                        - mainChain.begin() + 1;
                     binaryInsert(mainChain, pendingElements[i], limit);
                 }
             }
@@ -206,6 +339,9 @@ void PmergeMe::fordJohnsonSort(std::deque<int>& arr) {
         }
     }
     
+    /* one comparison per pair */
+    _comparisons += arr.size() / 2;
+
     if (arr.size() % 2 == 1) {
         hasStraggler = true;
         straggler = arr[arr.size() - 1];
@@ -249,13 +385,8 @@ void PmergeMe::fordJohnsonSort(std::deque<int>& arr) {
                 for (size_t j = end; j >= start && j >= 1; --j) {
                     size_t idx = j - 1;
                     if (idx < pendingElements.size() && !inserted[idx]) {
-                        size_t limit = mainChain.size();
-                        for (size_t k = 0; k < mainChain.size(); ++k) {
-                            if (mainChain[k] == pairs[idx].second) {
-                                limit = k + 1;
-                                break;
-                            }
-                        }
+                        size_t limit = std::lower_bound(mainChain.begin(), mainChain.end(), pairs[idx].second)
+                            - mainChain.begin() + 1;
                         binaryInsert(mainChain, pendingElements[idx], limit);
                         inserted[idx] = true;
                     }
@@ -264,13 +395,8 @@ void PmergeMe::fordJohnsonSort(std::deque<int>& arr) {
 
             for (size_t i = 1; i < pendingElements.size(); ++i) {
                 if (!inserted[i]) {
-                    size_t limit = mainChain.size();
-                    for (size_t k = 0; k < mainChain.size(); ++k) {
-                        if (mainChain[k] == pairs[i].second) {
-                            limit = k + 1;
-                            break;
-                        }
-                    }
+                    size_t limit = std::lower_bound(mainChain.begin(), mainChain.end(), pairs[i].second)
+                        - mainChain.begin() + 1;
                     binaryInsert(mainChain, pendingElements[i], limit);
                 }
             }
@@ -284,8 +410,127 @@ void PmergeMe::fordJohnsonSort(std::deque<int>& arr) {
     arr = mainChain;
 }
 
+void PmergeMe::fordJohnsonSort(BlockList& arr) {
+    if (arr.size() <= 1) return;
+
+    std::vector<std::pair<int, int> > pairs;
+    bool hasStraggler = false;
+    int straggler = 0;
+
+    for (size_t i = 0; i + 1 < arr.size(); i += 2) {
+        int a = arr[i];
+        int b = arr[i + 1];
+        if (a <= b) {
+            pairs.push_back(std::make_pair(a, b));
+        } else {
+            pairs.push_back(std::make_pair(b, a));
+        }
+    }
+
+    /* one comparison per pair */
+    _comparisons += arr.size() / 2;
+
+    if (arr.size() % 2 == 1) {
+        hasStraggler = true;
+        straggler = arr[arr.size() - 1];
+    }
+
+    BlockList largerElements;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        largerElements.push_back(pairs[i].second);
+    }
+
+    fordJohnsonSort(largerElements);
+
+    BlockList mainChain = largerElements;
+
+    std::vector<int> pendingElements;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        pendingElements.push_back(pairs[i].first);
+    }
+
+    /* the partner is found by an uncounted search, like the other paths */
+    if (!pendingElements.empty()) {
+        binaryInsert(mainChain, pendingElements[0], mainChain.size());
+
+        if (pendingElements.size() > 1) {
+            std::vector<size_t> jacobsthal = generateJacobsthalNumbers(pendingElements.size());
+            std::vector<bool> inserted(pendingElements.size(), false);
+            inserted[0] = true;
+
+            for (size_t i = 0; i < jacobsthal.size(); ++i) {
+                size_t jacobNum = jacobsthal[i];
+                size_t start = (i == 0) ? 2 : jacobsthal[i - 1] + 1;
+                size_t end = std::min(jacobNum, pendingElements.size());
+
+                for (size_t j = end; j >= start && j >= 1; --j) {
+                    size_t idx = j - 1;
+                    if (idx < pendingElements.size() && !inserted[idx]) {
+                        size_t limit = std::min(mainChain.rankOf(pairs[idx].second) + 1, mainChain.size());
+                        binaryInsert(mainChain, pendingElements[idx], limit);
+                        inserted[idx] = true;
+                    }
+                }
+            }
+
+            for (size_t i = 1; i < pendingElements.size(); ++i) {
+                if (!inserted[i]) {
+                    size_t limit = std::min(mainChain.rankOf(pairs[i].second) + 1, mainChain.size());
+                    binaryInsert(mainChain, pendingElements[i], limit);
+                }
+            }
+        }
+    }
+
+    if (hasStraggler) {
+        binaryInsert(mainChain, straggler, mainChain.size());
+    }
+
+    arr = mainChain;
+}
+
+void PmergeMe::runHybrid(const std::vector<int>& input, double vectorTime, size_t vectorComparisons) {
+    std::vector<int> arr(input);
+
+    _comparisons = 0;
+    _networkThreshold = _hybridThreshold;
+    double startTime = getTime();
+    fordJohnsonSort(arr);
+    double endTime = getTime();
+    _networkThreshold = 0;
+    double hybridTime = endTime - startTime;
+
+    if (arr != _vectorContainer) {
+        std::cerr << "Error" << std::endl;
+        return;
+    }
+
+    std::cout << "Time to process a range of " << arr.size()
+              << " elements with std::vector and a sorting network up to " << _hybridThreshold
+              << " elements : " << std::fixed << std::setprecision(5) << hybridTime << " us" << std::endl;
+
+    std::cout << "Speedup over std::vector : " << std::fixed << std::setprecision(2)
+              << (hybridTime > 0 ? vectorTime / hybridTime : 0.0) << "x" << std::endl;
+
+    std::cout << "Comparisons with the sorting network : " << _comparisons
+              << " (std::vector : " << vectorComparisons << ")" << std::endl;
+}
+
 void PmergeMe::run(int argc, char **argv) {
-    if (!parseInput(argc, argv)) return;
+    int first;
+    if (!parseOptions(argc, argv, first)) return;
+
+    /* numbers are optional when benchmarking, they add an "input" row */
+    if (_benchRepeats > 0) {
+        if ((argc > first || _inputMode != INPUT_ARGS) && !parseInput(argc, argv, first)) return;
+        runBenchmark();
+        return;
+    }
+    if (_streamBatch > 0) {
+        runStream(argc, argv, first);
+        return;
+    }
+    if (!parseInput(argc, argv, first)) return;
     
     if (_vectorContainer.empty()) { 
         std::cerr << "Error" << std::endl; 
@@ -294,25 +539,109 @@ void PmergeMe::run(int argc, char **argv) {
     
     printSequence(_vectorContainer, "Before:");
 
+    unsigned int containers = selectedContainers();
+    bool useVector = containers & CONTAINER_VECTOR;
+    bool useDeque = containers & CONTAINER_DEQUE;
+    bool useBlockList = containers & CONTAINER_BLOCKLIST;
 
-    double startTime = getTime();
-    fordJohnsonSort(_vectorContainer);
-    double endTime = getTime();
-    double vectorTime = endTime - startTime;
+    std::vector<int> unsorted;
+    if (_threadCount > 0 || _hybridThreshold > 0) unsorted = _vectorContainer;
+
+    BlockList blockContainer;
+    if (useBlockList) {
+        for (size_t i = 0; i < _vectorContainer.size(); ++i)
+            blockContainer.push_back(_vectorContainer[i]);
+    }
+    if (useDeque)
+        _dequeContainer.assign(_vectorContainer.begin(), _vectorContainer.end());
+
+    double vectorTime = 0;
+    double dequeTime = 0;
+    double blockTime = 0;
+    size_t vectorComparisons = 0;
+    size_t dequeComparisons = 0;
+    size_t blockComparisons = 0;
+    double startTime;
+    double endTime;
+
+    if (useVector) {
+        _comparisons = 0;
+        startTime = getTime();
+        fordJohnsonSort(_vectorContainer);
+        endTime = getTime();
+        vectorTime = endTime - startTime;
+        vectorComparisons = _comparisons;
+    }
+
+    if (useDeque) {
+        _comparisons = 0;
+        startTime = getTime();
+        fordJohnsonSort(_dequeContainer);
+        endTime = getTime();
+        dequeTime = endTime - startTime;
+        dequeComparisons = _comparisons;
+    }
+
+    if (useBlockList) {
+        _comparisons = 0;
+        startTime = getTime();
+        fordJohnsonSort(blockContainer);
+        endTime = getTime();
+        blockTime = endTime - startTime;
+        blockComparisons = _comparisons;
+    }
 
-    startTime = getTime();
-    fordJohnsonSort(_dequeContainer);
-    endTime = getTime();
-    double dequeTime = endTime - startTime;
+    /* the first timed container gives the sorted sequence, the others
+       are checked against it */
+    bool ok = true;
+    if (useVector) {
+        if (useDeque) ok = std::equal(_dequeContainer.begin(), _dequeContainer.end(), _vectorContainer.begin());
+    } else if (useDeque) {
+        _vectorContainer.assign(_dequeContainer.begin(), _dequeContainer.end());
+    }
+    if (useBlockList) {
+        std::vector<int> blockResult;
+        blockContainer.toVector(blockResult);
+        if (useVector || useDeque) ok = ok && blockResult == _vectorContainer;
+        else _vectorContainer.swap(blockResult);
+    }
+    if (!ok || std::adjacent_find(_vectorContainer.begin(), _vectorContainer.end(), std::greater<int>())
+            != _vectorContainer.end()) {
+        std::cerr << "Error" << std::endl;
+        return;
+    }
 
     printSequence(_vectorContainer, "After:");
+    std::cout << std::endl;
 
-    std::cout << std::endl
-              << "Time to process a range of " << _vectorContainer.size() 
-              << " elements with std::vector : " << std::fixed << std::setprecision(5) 
-              << vectorTime << " us" << std::endl;
+    if (useVector) {
+        std::cout << "Time to process a range of " << _vectorContainer.size() 
+                  << " elements with std::vector : " << std::fixed << std::setprecision(5) 
+                  << vectorTime << " us" << std::endl;
+    }
     
-    std::cout << "Time to process a range of " << _dequeContainer.size() 
-              << " elements with std::deque : " << std::fixed << std::setprecision(5) 
-              << dequeTime << " us" << std::endl;
+    if (useDeque) {
+        std::cout << "Time to process a range of " << _dequeContainer.size() 
+                  << " elements with std::deque : " << std::fixed << std::setprecision(5) 
+                  << dequeTime << " us" << std::endl;
+    }
+
+    if (useBlockList) {
+        std::cout << "Time to process a range of " << blockContainer.size() 
+                  << " elements with BlockList : " << std::fixed << std::setprecision(5) 
+                  << blockTime << " us" << std::endl;
+    }
+
+    if (_hybridThreshold > 0) {
+        std::cout << std::endl;
+        runHybrid(unsorted, vectorTime, vectorComparisons);
+    }
+
+    if (_threadCount > 0) {
+        std::cout << std::endl;
+        if (useVector) std::cout << "Comparisons with std::vector : " << vectorComparisons << std::endl;
+        if (useDeque) std::cout << "Comparisons with std::deque : " << dequeComparisons << std::endl;
+        if (useBlockList) std::cout << "Comparisons with BlockList : " << blockComparisons << std::endl;
+        runParallel(unsorted, vectorTime);
+    }
 }
@@ -7,15 +7,86 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
-#include <sys/time.h>
+#include <time.h>
 #include <iomanip>
+#include <functional>
+#include <cstring>
+#include <pthread.h>
+#include "BlockList.hpp"
+#include "SortingNetwork.hpp"
+
+/* limits of the parallel mode: at most this many threads, each with at
+   least this many elements, and a fixed number of splitter samples per block */
+#define PARALLEL_MAX_THREADS 64
+#define PARALLEL_MIN_BLOCK 1024
+#define PARALLEL_SAMPLES 16
+
+#define CONTAINER_VECTOR 1u
+#define CONTAINER_DEQUE 2u
+#define CONTAINER_BLOCKLIST 4u
+#define CONTAINER_ALL 7u
 
 class PmergeMe {
 private:
+    struct CountingLess {
+        size_t* counter;
+        explicit CountingLess(size_t* c) : counter(c) {}
+        bool operator()(int a, int b) const { if (counter) ++*counter; return a < b; }
+    };
+
+    /* one independently sorted slice of the input in parallel mode */
+    struct BlockTask {
+        std::vector<int> data;
+        bool counting;
+        size_t comparisons;
+    };
+
+    /* one value range of the final multiway merge in parallel mode */
+    struct MergeTask {
+        const std::vector<BlockTask>* blocks;
+        std::vector<std::pair<size_t, size_t> > ranges;
+        std::vector<int>* output;
+        size_t offset;
+        bool counting;
+        size_t comparisons;
+    };
+
+    /* running totals of the streaming mode */
+    struct StreamStats {
+        size_t batches;
+        size_t comparisons;
+        double totalTime;
+        double maxLatency;
+    };
+
+    enum InputMode { INPUT_ARGS, INPUT_FILE, INPUT_STDIN, INPUT_BINARY };
+    enum BenchAlgorithm { BENCH_VECTOR, BENCH_DEQUE, BENCH_BLOCKLIST, BENCH_HYBRID, BENCH_PARALLEL, BENCH_STD_SORT, BENCH_STABLE_SORT, BENCH_COUNT };
+
     std::vector<int> _vectorContainer;
     std::deque<int> _dequeContainer;
+    InputMode _inputMode;
+    std::string _inputPath;
+    size_t _threadCount;
+    size_t _hybridThreshold;
+    size_t _networkThreshold;
+    size_t _benchRepeats;
+    size_t _benchSize;
+    size_t _streamBatch;
+    unsigned int _containers;
+    bool _counting;
+    size_t _comparisons;
 
-    bool parseInput(int argc, char **argv);
+    bool parseOptions(int argc, char **argv, int& first);
+    bool parseInput(int argc, char **argv, int first);
+    bool parseCount(const std::string& str, size_t& out);
+    bool parseContainers(const std::string& list);
+    unsigned int selectedContainers() const;
+    bool parseNumber(const char*& p, const char* end, int& out);
+    bool parseText(const char* p, const char* end);
+    bool readTextFile(const std::string& path);
+    bool parseStdinChunk(std::vector<char>& pending, bool& eof);
+    bool readStdin();
+    bool readBinaryFile(const std::string& path);
     double getTime();
     void printSequence(const std::vector<int>& seq, const std::string& prefix);
 
@@ -23,10 +94,30 @@ private:
     
     void binaryInsert(std::vector<int>& arr, int value, size_t end);
     void binaryInsert(std::deque<int>& arr, int value, size_t end);
+    void binaryInsert(BlockList& arr, int value, size_t end);
 
     void fordJohnsonSort(std::vector<int>& arr);
     void fordJohnsonSort(std::deque<int>& arr);
-    
+    void fordJohnsonSort(BlockList& arr);
+
+    static void* sortBlockRoutine(void* arg);
+    static void* mergeRangeRoutine(void* arg);
+    size_t parallelSort(const std::vector<int>& input, std::vector<int>& output, size_t& comparisons, bool useThreads);
+    void runParallel(const std::vector<int>& input, double vectorTime);
+    void runHybrid(const std::vector<int>& input, double vectorTime, size_t vectorComparisons);
+
+    void generateDistribution(const std::string& name, size_t n, std::vector<int>& out);
+    double sortOnce(BenchAlgorithm algorithm, const std::vector<int>& source, size_t& comparisons, std::vector<int>& result);
+    double timeAlgorithm(BenchAlgorithm algorithm, const std::vector<int>& source, size_t* comparisons, std::vector<int>& result);
+    void benchmarkRow(const std::string& distribution, BenchAlgorithm algorithm,
+        const std::vector<int>& source, const std::vector<int>& expected);
+    void benchmark(const std::string& distribution, const std::vector<int>& source);
+    void runBenchmark();
+
+    void mergeBatch(std::vector<int>& sorted, std::vector<int>& batch, StreamStats& stats);
+    bool streamStdin(std::vector<int>& sorted, StreamStats& stats);
+    void runStream(int argc, char **argv, int first);
+
 public:
     PmergeMe();
     PmergeMe(const PmergeMe& other);
@@ -0,0 +1,186 @@
+#include "PmergeMe.hpp"
+#include <climits>
+
+namespace {
+
+const char* const algorithmNames[] = { "vector", "deque", "blocklist", "hybrid", "parallel", "std::sort", "std::stable_sort" };
+const char* const distributionNames[] = { "random", "sorted", "reversed", "duplicates", "organ-pipe" };
+
+/* fixed-seed xorshift so every build is measured on the same data */
+unsigned int nextRandom(unsigned int& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    if (rank == 0) rank = 1;
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+}
+
+void PmergeMe::generateDistribution(const std::string& name, size_t n, std::vector<int>& out) {
+    unsigned int state = 2463534242u;
+    out.clear();
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (name == "random") out.push_back(static_cast<int>(nextRandom(state) & INT_MAX));
+        else if (name == "sorted") out.push_back(static_cast<int>(i));
+        else if (name == "reversed") out.push_back(static_cast<int>(n - 1 - i));
+        else if (name == "duplicates") out.push_back(static_cast<int>(nextRandom(state) % 16));
+        else out.push_back(static_cast<int>(i < n / 2 ? i : n - 1 - i));
+    }
+}
+
+/* the copy into a fresh container happens before the clock starts and
+   the sorted output is copied into result after it stops */
+double PmergeMe::sortOnce(BenchAlgorithm algorithm, const std::vector<int>& source, size_t& comparisons,
+    std::vector<int>& result) {
+    double startTime = 0;
+    double endTime = 0;
+    comparisons = 0;
+    _comparisons = 0;
+
+    if (algorithm == BENCH_VECTOR) {
+        std::vector<int> arr(source);
+        startTime = getTime();
+        fordJohnsonSort(arr);
+        endTime = getTime();
+        comparisons = _comparisons;
+        result.swap(arr);
+    } else if (algorithm == BENCH_DEQUE) {
+        std::deque<int> arr(source.begin(), source.end());
+        startTime = getTime();
+        fordJohnsonSort(arr);
+        endTime = getTime();
+        comparisons = _comparisons;
+        result.assign(arr.begin(), arr.end());
+    } else if (algorithm == BENCH_BLOCKLIST) {
+        BlockList arr;
+        for (size_t i = 0; i < source.size(); ++i)
+            arr.push_back(source[i]);
+        startTime = getTime();
+        fordJohnsonSort(arr);
+        endTime = getTime();
+        comparisons = _comparisons;
+        arr.toVector(result);
+    } else if (algorithm == BENCH_HYBRID) {
+        std::vector<int> arr(source);
+        _networkThreshold = _hybridThreshold;
+        startTime = getTime();
+        fordJohnsonSort(arr);
+        endTime = getTime();
+        _networkThreshold = 0;
+        comparisons = _comparisons;
+        result.swap(arr);
+    } else if (algorithm == BENCH_PARALLEL) {
+        std::vector<int> arr;
+        startTime = getTime();
+        parallelSort(source, arr, comparisons, true);
+        endTime = getTime();
+        result.swap(arr);
+    } else {
+        std::vector<int> arr(source);
+        startTime = getTime();
+        if (_counting && algorithm == BENCH_STD_SORT) std::sort(arr.begin(), arr.end(), CountingLess(&comparisons));
+        else if (_counting) std::stable_sort(arr.begin(), arr.end(), CountingLess(&comparisons));
+        else if (algorithm == BENCH_STD_SORT) std::sort(arr.begin(), arr.end());
+        else std::stable_sort(arr.begin(), arr.end());
+        endTime = getTime();
+        result.swap(arr);
+    }
+    return endTime - startTime;
+}
+
+/* every row follows the same rule: the timed run has counting off, and
+   when comparisons is given one extra untimed run counts them */
+double PmergeMe::timeAlgorithm(BenchAlgorithm algorithm, const std::vector<int>& source, size_t* comparisons,
+    std::vector<int>& result) {
+    size_t ignored;
+    _counting = false;
+    double elapsed = sortOnce(algorithm, source, ignored, result);
+    _counting = true;
+
+    if (comparisons) {
+        std::vector<int> counted;
+        sortOnce(algorithm, source, *comparisons, counted);
+    }
+    return elapsed;
+}
+
+/* the warm-up output is checked against expected before any timed run */
+void PmergeMe::benchmarkRow(const std::string& distribution, BenchAlgorithm algorithm,
+    const std::vector<int>& source, const std::vector<int>& expected) {
+    size_t comparisons;
+    std::vector<int> result;
+    timeAlgorithm(algorithm, source, &comparisons, result);
+    if (result != expected) {
+        std::cerr << "Error" << std::endl;
+        return;
+    }
+
+    std::vector<double> samples;
+    for (size_t r = 0; r < _benchRepeats; ++r)
+        samples.push_back(timeAlgorithm(algorithm, source, NULL, result));
+    std::sort(samples.begin(), samples.end());
+
+    double median = samples[(samples.size() - 1) / 2];
+    if (samples.size() % 2 == 0) median = (median + samples[samples.size() / 2]) / 2;
+
+    std::cout << distribution << "," << algorithmNames[algorithm];
+    if (algorithm == BENCH_HYBRID) std::cout << "-" << _hybridThreshold;
+    std::cout << "," << source.size() << ","
+              << _benchRepeats << "," << std::fixed << std::setprecision(3)
+              << samples[0] << "," << median << "," << percentile(samples, 0.99) << ","
+              << comparisons << std::endl;
+}
+
+/* the hybrid rows sweep the network sizes plus any --hybrid threshold,
+   so the best threshold can be read off the CSV */
+void PmergeMe::benchmark(const std::string& distribution, const std::vector<int>& source) {
+    std::vector<int> expected(source);
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<size_t> thresholds;
+    for (size_t t = 8; t <= SORTING_NETWORK_MAX; t *= 2)
+        thresholds.push_back(t);
+    if (_hybridThreshold > 0 && std::find(thresholds.begin(), thresholds.end(), _hybridThreshold) == thresholds.end())
+        thresholds.push_back(_hybridThreshold);
+
+    unsigned int containers = selectedContainers();
+    for (int a = 0; a < BENCH_COUNT; ++a) {
+        BenchAlgorithm algorithm = static_cast<BenchAlgorithm>(a);
+        if (algorithm == BENCH_PARALLEL && _threadCount == 0) continue;
+        if (algorithm == BENCH_VECTOR && !(containers & CONTAINER_VECTOR)) continue;
+        if (algorithm == BENCH_DEQUE && !(containers & CONTAINER_DEQUE)) continue;
+        if (algorithm == BENCH_BLOCKLIST && !(containers & CONTAINER_BLOCKLIST)) continue;
+
+        if (algorithm == BENCH_HYBRID) {
+            size_t selected = _hybridThreshold;
+            for (size_t t = 0; t < thresholds.size(); ++t) {
+                _hybridThreshold = thresholds[t];
+                benchmarkRow(distribution, algorithm, source, expected);
+            }
+            _hybridThreshold = selected;
+        } else {
+            benchmarkRow(distribution, algorithm, source, expected);
+        }
+    }
+}
+
+/* one warm-up run, then _benchRepeats timed runs per algorithm and
+   distribution; all times are taken with comparison counting off */
+void PmergeMe::runBenchmark() {
+    std::cout << "distribution,algorithm,size,repeats,min_us,median_us,p99_us,comparisons" << std::endl;
+
+    std::vector<int> source;
+    for (size_t d = 0; d < sizeof(distributionNames) / sizeof(distributionNames[0]); ++d) {
+        generateDistribution(distributionNames[d], _benchSize, source);
+        benchmark(distributionNames[d], source);
+    }
+    if (!_vectorContainer.empty())
+        benchmark("input", _vectorContainer);
+}
@@ -0,0 +1,132 @@
+#include "PmergeMe.hpp"
+#include <climits>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* reads the digits at p in place and leaves p on the first non-digit;
+   a leading '-' or a value above INT_MAX is rejected like on argv */
+bool PmergeMe::parseNumber(const char*& p, const char* end, int& out) {
+    const char* start = p;
+    int value = 0;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        int digit = *p - '0';
+        if (value > (INT_MAX - digit) / 10) return false;
+        value = value * 10 + digit;
+        ++p;
+    }
+    if (p == start) return false;
+    out = value;
+    return true;
+}
+
+bool PmergeMe::parseText(const char* p, const char* end) {
+    while (true) {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+        if (p == end) return true;
+
+        int num;
+        if (!parseNumber(p, end, num)) return false;
+        if (p < end && !std::isspace(static_cast<unsigned char>(*p))) return false;
+
+        _vectorContainer.push_back(num);
+    }
+}
+
+bool PmergeMe::readTextFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    const char* begin = static_cast<const char*>(data);
+    bool ok = parseText(begin, begin + st.st_size);
+    munmap(data, st.st_size);
+    return ok;
+}
+
+/* reads one chunk of stdin into a fixed buffer and parses every number
+   that ended in it; a number cut at the end of the read stays in pending
+   until the next chunk, so memory does not grow with the input text */
+bool PmergeMe::parseStdinChunk(std::vector<char>& pending, bool& eof) {
+    char buffer[65536];
+    ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (n < 0) return false;
+    eof = (n == 0);
+
+    pending.insert(pending.end(), buffer, buffer + n);
+    size_t cut = pending.size();
+    if (!eof) {
+        while (cut > 0 && !std::isspace(static_cast<unsigned char>(pending[cut - 1]))) --cut;
+    }
+    if (cut > 0) {
+        if (!parseText(&pending[0], &pending[0] + cut)) return false;
+        pending.erase(pending.begin(), pending.begin() + cut);
+    }
+    return true;
+}
+
+bool PmergeMe::readStdin() {
+    std::vector<char> pending;
+    bool eof = false;
+    while (!eof) {
+        if (!parseStdinChunk(pending, eof)) return false;
+    }
+    return true;
+}
+
+/* raw little-endian int32 values, so the file size must be a multiple of 4 */
+bool PmergeMe::readBinaryFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size % 4 != 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    size_t count = st.st_size / 4;
+    _vectorContainer.reserve(count);
+
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i, bytes += 4) {
+        unsigned long value = static_cast<unsigned long>(bytes[0])
+            | static_cast<unsigned long>(bytes[1]) << 8
+            | static_cast<unsigned long>(bytes[2]) << 16
+            | static_cast<unsigned long>(bytes[3]) << 24;
+        if (value > static_cast<unsigned long>(INT_MAX)) {
+            ok = false;
+            break;
+        }
+        _vectorContainer.push_back(static_cast<int>(value));
+    }
+    munmap(data, st.st_size);
+    return ok;
+}
@@ -0,0 +1,182 @@
+#include "PmergeMe.hpp"
+
+namespace {
+
+/* min-heap order on (value, block) heads for the multiway merge */
+struct HeadGreater {
+    size_t* counter;
+    explicit HeadGreater(size_t* c) : counter(c) {}
+    bool operator()(const std::pair<int, size_t>& a, const std::pair<int, size_t>& b) const {
+        if (counter) ++*counter;
+        return a.first > b.first;
+    }
+};
+
+}
+
+void* PmergeMe::sortBlockRoutine(void* arg) {
+    BlockTask* task = static_cast<BlockTask*>(arg);
+    PmergeMe sorter;
+    sorter._counting = task->counting;
+    sorter.fordJohnsonSort(task->data);
+    task->comparisons = sorter._comparisons;
+    return NULL;
+}
+
+void* PmergeMe::mergeRangeRoutine(void* arg) {
+    MergeTask* task = static_cast<MergeTask*>(arg);
+    const std::vector<BlockTask>& blocks = *task->blocks;
+    HeadGreater greater(task->counting ? &task->comparisons : NULL);
+
+    std::vector<size_t> pos(blocks.size());
+    std::vector<std::pair<int, size_t> > heap;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        pos[b] = task->ranges[b].first;
+        if (pos[b] < task->ranges[b].second) {
+            heap.push_back(std::make_pair(blocks[b].data[pos[b]], b));
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+    }
+
+    size_t out = task->offset;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        size_t b = heap.back().second;
+        (*task->output)[out++] = heap.back().first;
+        heap.pop_back();
+        if (++pos[b] < task->ranges[b].second) {
+            heap.push_back(std::make_pair(blocks[b].data[pos[b]], b));
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+    }
+    return NULL;
+}
+
+/* sorts up to _threadCount slices with fordJohnsonSort concurrently, then
+   merges them by splitting the value space so every thread fills its own
+   part of the output; a failed pthread_create just runs that task on this
+   thread, and without useThreads every task does, which gives the
+   single-thread baseline of the same slicing. Returns the slice count */
+size_t PmergeMe::parallelSort(const std::vector<int>& input, std::vector<int>& output, size_t& comparisons,
+    bool useThreads) {
+    size_t threads = std::min(_threadCount, static_cast<size_t>(PARALLEL_MAX_THREADS));
+    threads = std::min(threads, input.size() / PARALLEL_MIN_BLOCK);
+    if (threads == 0) threads = 1;
+
+    std::vector<BlockTask> blocks(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        size_t begin = input.size() * t / threads;
+        size_t end = input.size() * (t + 1) / threads;
+        blocks[t].data.assign(input.begin() + begin, input.begin() + end);
+        blocks[t].counting = _counting;
+        blocks[t].comparisons = 0;
+    }
+
+    std::vector<pthread_t> ids(threads);
+    std::vector<bool> started(threads, false);
+    for (size_t t = 1; t < threads && useThreads; ++t)
+        started[t] = pthread_create(&ids[t], NULL, sortBlockRoutine, &blocks[t]) == 0;
+    sortBlockRoutine(&blocks[0]);
+    for (size_t t = 1; t < threads; ++t) {
+        if (started[t]) pthread_join(ids[t], NULL);
+        else sortBlockRoutine(&blocks[t]);
+    }
+
+    comparisons = 0;
+    for (size_t t = 0; t < threads; ++t)
+        comparisons += blocks[t].comparisons;
+
+    if (threads == 1) {
+        output.swap(blocks[0].data);
+        return threads;
+    }
+
+    /* pick threads - 1 splitters from evenly spaced samples of every block */
+    std::vector<int> samples;
+    for (size_t t = 0; t < threads; ++t) {
+        const std::vector<int>& data = blocks[t].data;
+        for (size_t s = 1; s <= PARALLEL_SAMPLES; ++s)
+            samples.push_back(data[(data.size() - 1) * s / (PARALLEL_SAMPLES + 1)]);
+    }
+    size_t* counter = _counting ? &comparisons : NULL;
+    std::sort(samples.begin(), samples.end(), CountingLess(counter));
+
+    std::vector<int> splitters;
+    for (size_t r = 1; r < threads; ++r)
+        splitters.push_back(samples[samples.size() * r / threads]);
+
+    std::vector<MergeTask> merges(threads);
+    size_t offset = 0;
+    for (size_t r = 0; r < threads; ++r) {
+        merges[r].blocks = &blocks;
+        merges[r].output = &output;
+        merges[r].offset = offset;
+        merges[r].counting = _counting;
+        merges[r].comparisons = 0;
+        for (size_t b = 0; b < threads; ++b) {
+            const std::vector<int>& data = blocks[b].data;
+            size_t lo = (r == 0) ? 0 : std::lower_bound(data.begin(), data.end(),
+                splitters[r - 1], CountingLess(counter)) - data.begin();
+            size_t hi = (r == threads - 1) ? data.size() : std::lower_bound(data.begin(), data.end(),
+                splitters[r], CountingLess(counter)) - data.begin();
+            merges[r].ranges.push_back(std::make_pair(lo, hi));
+            offset += hi - lo;
+        }
+    }
+
+    output.resize(input.size());
+    for (size_t t = 1; t < threads && useThreads; ++t)
+        started[t] = pthread_create(&ids[t], NULL, mergeRangeRoutine, &merges[t]) == 0;
+    mergeRangeRoutine(&merges[0]);
+    for (size_t t = 1; t < threads; ++t) {
+        if (started[t]) pthread_join(ids[t], NULL);
+        else mergeRangeRoutine(&merges[t]);
+    }
+
+    for (size_t t = 0; t < threads; ++t)
+        comparisons += merges[t].comparisons;
+    return threads;
+}
+
+/* the thread speedup is measured against the same slices sorted and merged
+   on this thread; the ratio to one full-length sort also includes the gain
+   of sorting shorter slices, which shows even on a single core */
+void PmergeMe::runParallel(const std::vector<int>& input, double vectorTime) {
+    std::vector<int> result;
+    size_t comparisons = 0;
+
+    double startTime = getTime();
+    size_t threads = parallelSort(input, result, comparisons, true);
+    double endTime = getTime();
+    double parallelTime = endTime - startTime;
+
+    std::vector<int> slicedResult;
+    size_t slicedComparisons = 0;
+    startTime = getTime();
+    parallelSort(input, slicedResult, slicedComparisons, false);
+    endTime = getTime();
+    double slicedTime = endTime - startTime;
+
+    if (result != _vectorContainer || slicedResult != _vectorContainer) {
+        std::cerr << "Error" << std::endl;
+        return;
+    }
+
+    std::cout << "Time to process a range of " << result.size()
+              << " elements with " << threads << " threads : " << std::fixed << std::setprecision(5)
+              << parallelTime << " us" << std::endl;
+
+    std::cout << "Time to process a range of " << result.size()
+              << " elements in " << threads << " slices on one thread : " << std::fixed << std::setprecision(5)
+              << slicedTime << " us" << std::endl;
+
+    std::cout << "Speedup from threads : " << std::fixed << std::setprecision(2)
+              << (parallelTime > 0 ? slicedTime / parallelTime : 0.0) << "x" << std::endl;
+
+    std::cout << "Speedup over std::vector, including the gain from smaller slices : "
+              << std::fixed << std::setprecision(2)
+              << (parallelTime > 0 ? vectorTime / parallelTime : 0.0) << "x" << std::endl;
+
+    std::cout << "Comparisons with " << threads << " threads : " << comparisons
+              << " (" << threads << " slices on one thread : " << slicedComparisons << ")" << std::endl;
+}
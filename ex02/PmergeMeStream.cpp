@@ -0,0 +1,87 @@
+#include "PmergeMe.hpp"
+
+/* sorts one batch with fordJohnsonSort and merges it into the sorted
+   state, which is a complete sorted view again when this returns */
+void PmergeMe::mergeBatch(std::vector<int>& sorted, std::vector<int>& batch, StreamStats& stats) {
+    _comparisons = 0;
+    double startTime = getTime();
+    fordJohnsonSort(batch);
+    size_t middle = sorted.size();
+    sorted.insert(sorted.end(), batch.begin(), batch.end());
+    std::inplace_merge(sorted.begin(), sorted.begin() + middle, sorted.end(), CountingLess(&_comparisons));
+    double endTime = getTime();
+    double latency = endTime - startTime;
+
+    ++stats.batches;
+    stats.comparisons += _comparisons;
+    stats.totalTime += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+
+    std::cout << "Batch " << stats.batches << " : " << batch.size() << " elements merged into "
+              << sorted.size() << " sorted in " << std::fixed << std::setprecision(5) << latency
+              << " us (" << _comparisons << " comparisons)" << std::endl;
+}
+
+/* feeds batches as soon as enough numbers arrived instead of waiting for
+   end of input */
+bool PmergeMe::streamStdin(std::vector<int>& sorted, StreamStats& stats) {
+    std::vector<char> pending;
+    bool eof = false;
+
+    while (true) {
+        if (!parseStdinChunk(pending, eof)) return false;
+
+        size_t used = 0;
+        while (_vectorContainer.size() - used >= _streamBatch || (eof && used < _vectorContainer.size())) {
+            size_t take = std::min(_streamBatch, _vectorContainer.size() - used);
+            std::vector<int> batch(_vectorContainer.begin() + used, _vectorContainer.begin() + used + take);
+            mergeBatch(sorted, batch, stats);
+            used += take;
+        }
+        _vectorContainer.erase(_vectorContainer.begin(), _vectorContainer.begin() + used);
+
+        if (eof) return true;
+    }
+}
+
+void PmergeMe::runStream(int argc, char **argv, int first) {
+    std::vector<int> sorted;
+    StreamStats stats;
+    stats.batches = 0;
+    stats.comparisons = 0;
+    stats.totalTime = 0;
+    stats.maxLatency = 0;
+
+    if (_inputMode == INPUT_STDIN && argc == first) {
+        if (!streamStdin(sorted, stats)) {
+            std::cerr << "Error" << std::endl;
+            return;
+        }
+    } else {
+        if (!parseInput(argc, argv, first)) return;
+        for (size_t used = 0; used < _vectorContainer.size(); used += _streamBatch) {
+            size_t take = std::min(_streamBatch, _vectorContainer.size() - used);
+            std::vector<int> batch(_vectorContainer.begin() + used, _vectorContainer.begin() + used + take);
+            mergeBatch(sorted, batch, stats);
+        }
+    }
+
+    if (sorted.empty()) {
+        std::cerr << "Error" << std::endl;
+        return;
+    }
+
+    std::cout << std::endl;
+    printSequence(sorted, "After:");
+
+    std::cout << std::endl
+              << "Time to stream a range of " << sorted.size() << " elements in " << stats.batches
+              << " batches : " << std::fixed << std::setprecision(5) << stats.totalTime << " us" << std::endl;
+
+    std::cout << "Amortized cost : " << std::fixed << std::setprecision(5)
+              << stats.totalTime / sorted.size() << " us and " << std::setprecision(2)
+              << static_cast<double>(stats.comparisons) / sorted.size() << " comparisons per element" << std::endl;
+
+    std::cout << "Batch latency : " << std::fixed << std::setprecision(5)
+              << stats.totalTime / stats.batches << " us average, " << stats.maxLatency << " us max" << std::endl;
+}
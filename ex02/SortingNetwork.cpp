@@ -0,0 +1,183 @@
+#include "SortingNetwork.hpp"
+#include <climits>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#ifdef __SSE2__
+
+typedef __m128i Lanes;
+
+inline Lanes loadLanes(const int* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void storeLanes(int* p, Lanes v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+/* SSE2 has no 32-bit min/max, so select through a compare mask */
+inline Lanes minLanes(Lanes a, Lanes b) {
+    Lanes m = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(m, b), _mm_andnot_si128(m, a));
+}
+
+inline Lanes maxLanes(Lanes a, Lanes b) {
+    Lanes m = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+inline Lanes reverseLanes(Lanes v) {
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+/* sorts one bitonic register: compare lanes two apart, then neighbours */
+inline Lanes sortBitonicLanes(Lanes v) {
+    Lanes t = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm_unpacklo_epi64(minLanes(v, t), maxLanes(v, t));
+    t = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    Lanes lo = _mm_shuffle_epi32(minLanes(v, t), _MM_SHUFFLE(2, 0, 2, 0));
+    Lanes hi = _mm_shuffle_epi32(maxLanes(v, t), _MM_SHUFFLE(2, 0, 2, 0));
+    return _mm_unpacklo_epi32(lo, hi);
+}
+
+inline void transposeLanes(Lanes* r) {
+    Lanes t0 = _mm_unpacklo_epi32(r[0], r[1]);
+    Lanes t1 = _mm_unpacklo_epi32(r[2], r[3]);
+    Lanes t2 = _mm_unpackhi_epi32(r[0], r[1]);
+    Lanes t3 = _mm_unpackhi_epi32(r[2], r[3]);
+    r[0] = _mm_unpacklo_epi64(t0, t1);
+    r[1] = _mm_unpackhi_epi64(t0, t1);
+    r[2] = _mm_unpacklo_epi64(t2, t3);
+    r[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+#else
+
+struct Lanes {
+    int v[4];
+};
+
+inline Lanes loadLanes(const int* p) {
+    Lanes r;
+    for (int i = 0; i < 4; ++i) r.v[i] = p[i];
+    return r;
+}
+
+inline void storeLanes(int* p, Lanes a) {
+    for (int i = 0; i < 4; ++i) p[i] = a.v[i];
+}
+
+inline Lanes minLanes(Lanes a, Lanes b) {
+    for (int i = 0; i < 4; ++i) a.v[i] = std::min(a.v[i], b.v[i]);
+    return a;
+}
+
+inline Lanes maxLanes(Lanes a, Lanes b) {
+    for (int i = 0; i < 4; ++i) a.v[i] = std::max(a.v[i], b.v[i]);
+    return a;
+}
+
+inline Lanes reverseLanes(Lanes a) {
+    std::swap(a.v[0], a.v[3]);
+    std::swap(a.v[1], a.v[2]);
+    return a;
+}
+
+inline Lanes sortBitonicLanes(Lanes a) {
+    for (int d = 2; d >= 1; d /= 2) {
+        for (int i = 0; i < 4; ++i) {
+            if ((i & d) == 0) {
+                int lo = std::min(a.v[i], a.v[i + d]);
+                int hi = std::max(a.v[i], a.v[i + d]);
+                a.v[i] = lo;
+                a.v[i + d] = hi;
+            }
+        }
+    }
+    return a;
+}
+
+inline void transposeLanes(Lanes* r) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i + 1; j < 4; ++j)
+            std::swap(r[i].v[j], r[j].v[i]);
+    }
+}
+
+#endif
+
+inline void compareExchange(Lanes& a, Lanes& b) {
+    Lanes lo = minLanes(a, b);
+    b = maxLanes(a, b);
+    a = lo;
+}
+
+/* sorts each lane across four registers, then transposes so that every
+   register holds one sorted run of four */
+size_t sortColumns(Lanes* r) {
+    compareExchange(r[0], r[1]);
+    compareExchange(r[2], r[3]);
+    compareExchange(r[0], r[2]);
+    compareExchange(r[1], r[3]);
+    compareExchange(r[1], r[2]);
+    transposeLanes(r);
+    return 5 * 4;
+}
+
+/* merges the two sorted halves of r[0..count) into one sorted run */
+size_t bitonicMerge(Lanes* r, size_t count) {
+    size_t half = count / 2;
+    size_t comparisons = 0;
+
+    for (size_t i = 0; i < half / 2; ++i)
+        std::swap(r[half + i], r[count - 1 - i]);
+    for (size_t i = half; i < count; ++i)
+        r[i] = reverseLanes(r[i]);
+
+    for (size_t stride = half; stride >= 1; stride /= 2) {
+        for (size_t i = 0; i < count; ++i) {
+            if ((i & stride) == 0) {
+                compareExchange(r[i], r[i + stride]);
+                comparisons += 4;
+            }
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        r[i] = sortBitonicLanes(r[i]);
+        comparisons += 8;
+    }
+    return comparisons;
+}
+
+}
+
+size_t sortingNetwork(int* data, size_t n) {
+    if (n <= 1) return 0;
+
+    int buffer[SORTING_NETWORK_MAX];
+    size_t count = (n <= 16) ? 4 : 8;
+    std::copy(data, data + n, buffer);
+    std::fill(buffer + n, buffer + count * 4, INT_MAX);
+
+    Lanes r[SORTING_NETWORK_MAX / 4];
+    for (size_t i = 0; i < count; ++i)
+        r[i] = loadLanes(buffer + i * 4);
+
+    size_t comparisons = 0;
+    for (size_t g = 0; g < count; g += 4)
+        comparisons += sortColumns(r + g);
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t start = 0; start < count; start += 2 * width)
+            comparisons += bitonicMerge(r + start, 2 * width);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        storeLanes(buffer + i * 4, r[i]);
+    std::copy(buffer, buffer + n, data);
+    return comparisons;
+}
@@ -0,0 +1,13 @@
+#ifndef SORTINGNETWORK_HPP
+#define SORTINGNETWORK_HPP
+
+#include <cstddef>
+
+#define SORTING_NETWORK_MAX 32
+
+/* sorts n <= SORTING_NETWORK_MAX ints with a branch-free bitonic network
+   (16 or 32 lanes, padded with INT_MAX) and returns the number of lane
+   comparisons it made; uses SSE2 when available, plain ints otherwise */
+size_t sortingNetwork(int* data, size_t n);
+
+#endif